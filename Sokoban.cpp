@@ -4,10 +4,15 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <algorithm>
 #include <SFML/Audio.hpp>
 
 namespace SB {
 
+// Every direction, in the order used to index per-direction tables
+const Direction allDirections[4] = {
+    Direction::Up, Direction::Down, Direction::Left, Direction::Right };
+
 Sokoban::Sokoban() : boardWidth(0), boardHeight(0), playerPosition(0, 0) {
     tileTextures.resize(static_cast<size_t>(4));  // We have 4 total types of texture.
 
@@ -125,21 +130,9 @@ void Sokoban::movePlayer(Direction direction) {
     }
     latestMove = direction;
 
-    int deltaX = 0;
-    int deltaY = 0;
-    switch (direction) {
-      case SB::Direction::Right:
-        deltaX = 1;
-        break;
-      case SB::Direction::Left:
-        deltaX = -1;
-        break;
-      case SB::Direction::Up:
-        deltaY = -1;
-        break;
-      case SB::Direction::Down:
-        deltaY = 1;
-    }
+    sf::Vector2i delta = directionDelta(direction);
+    int deltaX = delta.x;
+    int deltaY = delta.y;
 
     // Check if Player is out of bounds.
     int newPlayerX = playerPosition.x + deltaX;
@@ -189,6 +182,64 @@ void Sokoban::movePlayer(Direction direction) {
     }
 }
 
+int Sokoban::pushThrough(Direction direction) {
+    sf::Vector2i delta = directionDelta(direction);
+    std::vector<Direction> moves = macroMoves(playerPosition + delta, direction);
+
+    // Replay the planned moves, counting only the ones that push a box.
+    int pushes = 0;
+    for (Direction move : moves) {
+        if (isWon()) {
+            break;
+        }
+        sf::Vector2i ahead = playerPosition + directionDelta(move);
+        bool pushing = !isOutOfBounds(ahead.x, ahead.y) &&
+            gameBoard[ahead.y * boardWidth + ahead.x] == Tile::Box;
+        movePlayer(move);
+        if (pushing && playerPosition == ahead) {
+            ++pushes;
+        }
+    }
+
+    // No macro here, so behave like a plain arrow key.
+    if (pushes == 0) {
+        movePlayer(direction);
+    }
+    return pushes;
+}
+
+std::vector<Direction> Sokoban::macroMoves(sf::Vector2i box, Direction direction) const {
+    std::vector<Direction> moves;
+    planMacro(gameBoard, box - directionDelta(direction), direction, moves);
+    return moves;
+}
+
+int Sokoban::macroLength(sf::Vector2i box, Direction direction) const {
+    std::vector<Direction> moves;
+    return planMacro(gameBoard, box - directionDelta(direction), direction, moves);
+}
+
+bool Sokoban::isTunnel(sf::Vector2i cell, Direction direction) const {
+    if (isOutOfBounds(cell.x, cell.y)) {
+        return false;
+    }
+    return tunnelCells[static_cast<size_t>(direction)][cell.y * boardWidth + cell.x];
+}
+
+bool Sokoban::isArticulationPoint(sf::Vector2i cell) const {
+    if (isOutOfBounds(cell.x, cell.y)) {
+        return false;
+    }
+    return articulationPoints[cell.y * boardWidth + cell.x];
+}
+
+bool Sokoban::isGoalRoom(sf::Vector2i cell) const {
+    if (isOutOfBounds(cell.x, cell.y)) {
+        return false;
+    }
+    return goalRooms[cell.y * boardWidth + cell.x] >= 0;
+}
+
 bool Sokoban::isWon() const {
     int storageCount = 0;
     int boxOnStorageCount = 0;
@@ -263,6 +314,9 @@ std::istream& operator>>(std::istream& in, Sokoban& game) {
         // Preserve a copy of original game board & player location so we can reset later.
         game.originalGameBoard = game.gameBoard;
         game.originalPlayerPosition = game.playerPosition;
+
+        // Tunnels and goal rooms only depend on the walls, so analyze them once per level.
+        game.analyzeLevel();
     }
     return in;
 }
@@ -296,8 +350,385 @@ std::ostream& operator<<(std::ostream& out, const Sokoban& game) {
     return out;
 }
 
-bool Sokoban::isOutOfBounds(int x, int y) {
+sf::Vector2i Sokoban::directionDelta(Direction direction) {
+    switch (direction) {
+      case SB::Direction::Right:
+        return sf::Vector2i(1, 0);
+      case SB::Direction::Left:
+        return sf::Vector2i(-1, 0);
+      case SB::Direction::Up:
+        return sf::Vector2i(0, -1);
+      case SB::Direction::Down:
+      default:
+        return sf::Vector2i(0, 1);
+    }
+}
+
+bool Sokoban::isOutOfBounds(int x, int y) const {
     return (x < 0 || y < 0 || x >= boardWidth || y >= boardHeight);
 }
 
+bool Sokoban::isFloor(int x, int y) const {
+    return !isOutOfBounds(x, y) && originalGameBoard[y * boardWidth + x] != Tile::Wall;
+}
+
+bool Sokoban::isOneWide(int x, int y, Direction direction) const {
+    if (!isFloor(x, y)) {
+        return false;
+    }
+    if (direction == Direction::Left || direction == Direction::Right) {
+        return !isFloor(x, y - 1) && !isFloor(x, y + 1);
+    }
+    return !isFloor(x - 1, y) && !isFloor(x + 1, y);
+}
+
+Tile Sokoban::floorTile(int index) const {
+    return originalGameBoard[index] == Tile::Storage ? Tile::Storage : Tile::Empty;
+}
+
+void Sokoban::analyzeLevel() {
+    size_t cellCount = originalGameBoard.size();
+    tunnelCells.assign(4, std::vector<bool>(cellCount, false));
+    articulationPoints.assign(cellCount, false);
+    goalRooms.assign(cellCount, -1);
+    roomEntrances.clear();
+    roomSlots.clear();
+
+    // Tunnels: one-wide cells whose run in the direction reaches storage, or opens
+    // onto wider floor the box can keep moving across. Dead ends and dead corners
+    // are left out so boxes are never driven into them.
+    for (Direction direction : allDirections) {
+        // Sweep against the direction so the next cell along it is always decided first.
+        sf::Vector2i delta = directionDelta(direction);
+        bool backwards = direction == Direction::Right || direction == Direction::Down;
+        std::vector<bool>& tunnel = tunnelCells[static_cast<size_t>(direction)];
+        for (size_t i = 0; i < cellCount; ++i) {
+            int index = static_cast<int>(backwards ? cellCount - 1 - i : i);
+            int x = index % boardWidth;
+            int y = index / boardWidth;
+            if (!isOneWide(x, y, direction)) {
+                continue;
+            }
+            int nx = x + delta.x;
+            int ny = y + delta.y;
+            bool hasExit = false;
+            if (isFloor(nx, ny)) {
+                int next = ny * boardWidth + nx;
+                if (originalGameBoard[next] == Tile::Storage) {
+                    hasExit = true;
+                } else if (isOneWide(nx, ny, direction)) {
+                    hasExit = tunnel[next];
+                } else {
+                    hasExit = isFloor(nx + delta.x, ny + delta.y);
+                }
+            }
+            tunnel[index] = originalGameBoard[index] == Tile::Storage || hasExit;
+        }
+    }
+
+    // Articulation points of the floor graph, one search per connected area.
+    int time = 0;
+    std::vector<int> discovery(cellCount, 0);
+    std::vector<int> low(cellCount, 0);
+    for (int i = 0; i < static_cast<int>(cellCount); ++i) {
+        if (discovery[i] == 0 && isFloor(i % boardWidth, i / boardWidth)) {
+            findArticulationPoints(i, time, discovery, low);
+        }
+    }
+
+    // Goal rooms: areas left after removing articulation points that hold storage,
+    // are entered through exactly one articulation point, and start without the
+    // player or any box inside.
+    int playerCell = originalPlayerPosition.y * boardWidth + originalPlayerPosition.x;
+    std::vector<bool> visited(cellCount, false);
+    for (int start = 0; start < static_cast<int>(cellCount); ++start) {
+        if (visited[start] || articulationPoints[start] ||
+            !isFloor(start % boardWidth, start / boardWidth)) {
+            continue;
+        }
+        std::vector<int> cells(1, start);
+        visited[start] = true;
+        bool hasStorage = false;
+        bool isOccupied = false;
+        int entrance = -1;
+        bool hasOneEntrance = true;
+        for (size_t next = 0; next < cells.size(); ++next) {
+            sf::Vector2i cell(cells[next] % boardWidth, cells[next] / boardWidth);
+            if (originalGameBoard[cells[next]] == Tile::Storage) {
+                hasStorage = true;
+            }
+            if (originalGameBoard[cells[next]] == Tile::Box || cells[next] == playerCell) {
+                isOccupied = true;
+            }
+            for (Direction direction : allDirections) {
+                sf::Vector2i near = cell + directionDelta(direction);
+                if (!isFloor(near.x, near.y)) {
+                    continue;
+                }
+                int neighbour = near.y * boardWidth + near.x;
+                if (articulationPoints[neighbour]) {
+                    if (entrance >= 0 && entrance != neighbour) {
+                        hasOneEntrance = false;
+                    }
+                    entrance = neighbour;
+                } else if (!visited[neighbour]) {
+                    visited[neighbour] = true;
+                    cells.push_back(neighbour);
+                }
+            }
+        }
+        if (!hasStorage || isOccupied || entrance < 0 || !hasOneEntrance) {
+            continue;
+        }
+
+        int room = static_cast<int>(roomEntrances.size());
+        for (int cell : cells) {
+            goalRooms[cell] = room;
+        }
+
+        // Fill the room from the far end so parked boxes never block the way in.
+        std::vector<bool> seen(cellCount, false);
+        std::vector<int> order(1, entrance);
+        seen[entrance] = true;
+        for (size_t next = 0; next < order.size(); ++next) {
+            sf::Vector2i cell(order[next] % boardWidth, order[next] / boardWidth);
+            for (Direction direction : allDirections) {
+                sf::Vector2i near = cell + directionDelta(direction);
+                int neighbour = near.y * boardWidth + near.x;
+                if (isFloor(near.x, near.y) && goalRooms[neighbour] == room && !seen[neighbour]) {
+                    seen[neighbour] = true;
+                    order.push_back(neighbour);
+                }
+            }
+        }
+        std::vector<int> slots;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            if (originalGameBoard[*it] == Tile::Storage) {
+                slots.push_back(*it);
+            }
+        }
+        roomEntrances.push_back(entrance);
+        roomSlots.push_back(slots);
+    }
+}
+
+void Sokoban::findArticulationPoints(int start, int& time,
+    std::vector<int>& discovery, std::vector<int>& low) {
+    // Iterative DFS so long winding corridors can't overflow the call stack.
+    std::vector<int> stack(1, start);
+    std::vector<int> parent(discovery.size(), -1);
+    std::vector<int> nextNeighbour(discovery.size(), 0);
+    discovery[start] = low[start] = ++time;
+    int rootChildren = 0;
+    while (!stack.empty()) {
+        int cell = stack.back();
+        if (nextNeighbour[cell] < 4) {
+            sf::Vector2i near = sf::Vector2i(cell % boardWidth, cell / boardWidth) +
+                directionDelta(allDirections[nextNeighbour[cell]++]);
+            if (!isFloor(near.x, near.y)) {
+                continue;
+            }
+            int neighbour = near.y * boardWidth + near.x;
+            if (discovery[neighbour] == 0) {
+                parent[neighbour] = cell;
+                discovery[neighbour] = low[neighbour] = ++time;
+                stack.push_back(neighbour);
+                if (cell == start) {
+                    ++rootChildren;
+                }
+            } else if (neighbour != parent[cell]) {
+                low[cell] = std::min(low[cell], discovery[neighbour]);
+            }
+            continue;
+        }
+
+        // All neighbours done, report back to the parent.
+        stack.pop_back();
+        int up = parent[cell];
+        if (up < 0) {
+            continue;
+        }
+        low[up] = std::min(low[up], low[cell]);
+        if (up != start && low[cell] >= discovery[up]) {
+            articulationPoints[up] = true;
+        }
+    }
+    // The root of the search is only a cut point if it has several subtrees.
+    if (rootChildren > 1) {
+        articulationPoints[start] = true;
+    }
+}
+
+int Sokoban::planMacro(const std::vector<Tile>& start, sf::Vector2i player,
+    Direction direction, std::vector<Direction>& moves) const {
+    sf::Vector2i delta = directionDelta(direction);
+    sf::Vector2i box = player + delta;
+    if (!isFloor(player.x, player.y) || start[player.y * boardWidth + player.x] == Tile::Box ||
+        isOutOfBounds(box.x, box.y) || start[box.y * boardWidth + box.x] != Tile::Box) {
+        return 0;
+    }
+
+    // Work on a copy of the board so planning never touches the game it came from.
+    std::vector<Tile> board = start;
+    int pushes = 0;
+    while (true) {
+        sf::Vector2i next = box + delta;
+        if (!isFloor(next.x, next.y) || board[next.y * boardWidth + next.x] == Tile::Box) {
+            break;
+        }
+        board[next.y * boardWidth + next.x] = Tile::Box;
+        board[box.y * boardWidth + box.x] = floorTile(box.y * boardWidth + box.x);
+        player = box;
+        box = next;
+        moves.push_back(direction);
+        ++pushes;
+
+        int boxIndex = box.y * boardWidth + box.x;
+        if (originalGameBoard[boxIndex] == Tile::Storage) {
+            break;
+        }
+
+        // At a goal room's entrance, or loose inside one, carry the box to its slot.
+        int room = goalRooms[boxIndex];
+        for (size_t i = 0; room < 0 && i < roomEntrances.size(); ++i) {
+            if (roomEntrances[i] == boxIndex) {
+                room = static_cast<int>(i);
+            }
+        }
+        if (room >= 0) {
+            planRoomPushes(board, player, box, room, moves, pushes);
+            break;
+        }
+        if (!isTunnel(box, direction)) {
+            break;
+        }
+    }
+    return pushes;
+}
+
+bool Sokoban::planRoomPushes(std::vector<Tile>& board, sf::Vector2i& player,
+    sf::Vector2i& box, int room, std::vector<Direction>& moves, int& pushes) const {
+    // Breadth-first search over (box cell, push direction) states, keeping the box
+    // inside the room. The player's reachable area is worked out once per box move
+    // and each of the four push cells is looked up in it.
+    std::vector<Tile> empty = board;
+    int boxIndex = box.y * boardWidth + box.x;
+    empty[boxIndex] = floorTile(boxIndex);
+    std::vector<int> parent(board.size() * 4, -2);
+    std::vector<int> arrival(board.size(), -1);
+    std::vector<int> queue;
+    std::vector<int> step;
+    std::vector<int> walkQueue;
+    findReachable(board, player, step, walkQueue);
+    for (int d = 0; d < 4; ++d) {
+        sf::Vector2i push = box - directionDelta(allDirections[d]);
+        if (isFloor(push.x, push.y) && step[push.y * boardWidth + push.x] >= 0) {
+            parent[boxIndex * 4 + d] = -1;
+            queue.push_back(boxIndex * 4 + d);
+        }
+    }
+    for (size_t next = 0; next < queue.size(); ++next) {
+        int cell = queue[next] / 4;
+        sf::Vector2i from(cell % boardWidth, cell / boardWidth);
+        sf::Vector2i to = from + directionDelta(allDirections[queue[next] % 4]);
+        int target = to.y * boardWidth + to.x;
+        if (!isFloor(to.x, to.y) || goalRooms[target] != room || empty[target] == Tile::Box) {
+            continue;
+        }
+        if (arrival[target] < 0) {
+            arrival[target] = queue[next];
+        }
+        bool hasNewState = false;
+        for (int d = 0; d < 4; ++d) {
+            hasNewState = hasNewState || parent[target * 4 + d] == -2;
+        }
+        if (!hasNewState) {
+            continue;
+        }
+        empty[target] = Tile::Box;
+        findReachable(empty, from, step, walkQueue);
+        empty[target] = floorTile(target);
+        for (int d = 0; d < 4; ++d) {
+            sf::Vector2i push = to - directionDelta(allDirections[d]);
+            int state = target * 4 + d;
+            if (parent[state] == -2 && isFloor(push.x, push.y) &&
+                step[push.y * boardWidth + push.x] >= 0) {
+                parent[state] = queue[next];
+                queue.push_back(state);
+            }
+        }
+    }
+
+    // Take the first free slot in fill order the box can reach.
+    int slot = -1;
+    for (int candidate : roomSlots[room]) {
+        if (board[candidate] != Tile::Box && arrival[candidate] >= 0) {
+            slot = candidate;
+            break;
+        }
+    }
+    if (slot < 0) {
+        return false;
+    }
+    std::vector<int> path;
+    for (int state = arrival[slot]; state >= 0; state = parent[state]) {
+        path.push_back(state);
+    }
+
+    // Replay the pushes, walking the player round the box between them.
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        Direction direction = allDirections[*it % 4];
+        sf::Vector2i delta = directionDelta(direction);
+        findPlayerPath(board, player, box - delta, moves);
+        sf::Vector2i next = box + delta;
+        board[next.y * boardWidth + next.x] = Tile::Box;
+        board[box.y * boardWidth + box.x] = floorTile(box.y * boardWidth + box.x);
+        player = box;
+        box = next;
+        moves.push_back(direction);
+        ++pushes;
+    }
+    return true;
+}
+
+void Sokoban::findReachable(const std::vector<Tile>& board, sf::Vector2i from,
+    std::vector<int>& step, std::vector<int>& queue) const {
+    // Breadth-first search over free floor. Each reached cell remembers the index of
+    // the direction that stepped into it, 4 for the start, -1 if unreachable.
+    step.assign(board.size(), -1);
+    queue.assign(1, from.y * boardWidth + from.x);
+    step[queue[0]] = 4;
+    for (size_t next = 0; next < queue.size(); ++next) {
+        for (int d = 0; d < 4; ++d) {
+            sf::Vector2i cell = sf::Vector2i(queue[next] % boardWidth, queue[next] / boardWidth) +
+                directionDelta(allDirections[d]);
+            int index = cell.y * boardWidth + cell.x;
+            if (isFloor(cell.x, cell.y) && board[index] != Tile::Box && step[index] < 0) {
+                step[index] = d;
+                queue.push_back(index);
+            }
+        }
+    }
+}
+
+bool Sokoban::findPlayerPath(const std::vector<Tile>& board, sf::Vector2i from,
+    sf::Vector2i to, std::vector<Direction>& moves) const {
+    if (!isFloor(to.x, to.y)) {
+        return false;
+    }
+    std::vector<int> step;
+    std::vector<int> queue;
+    findReachable(board, from, step, queue);
+    if (step[to.y * boardWidth + to.x] < 0) {
+        return false;
+    }
+    std::vector<Direction> walk;
+    for (sf::Vector2i cell = to; step[cell.y * boardWidth + cell.x] != 4;
+        cell -= directionDelta(walk.back())) {
+        walk.push_back(allDirections[step[cell.y * boardWidth + cell.x]]);
+    }
+    moves.insert(moves.end(), walk.rbegin(), walk.rend());
+    return true;
+}
+
 }  // namespace SB
@@ -33,6 +33,27 @@ class Sokoban : public sf::Drawable {
     // Moves the player in the specified direction
     void movePlayer(Direction direction);
 
+    // Pushes the box in front of the player through a tunnel or into its
+    // goal-room slot as one macro move. Returns the number of pushes made; when no
+    // macro applies it falls back to a normal movePlayer step and returns 0.
+    int pushThrough(Direction direction);
+
+    // Returns the player moves of the macro push of the box at a cell, with the
+    // player standing behind it, without changing the game. Empty if it can't move.
+    std::vector<Direction> macroMoves(sf::Vector2i box, Direction direction) const;
+
+    // Returns the number of pushes in that macro move, 0 if the box can't move
+    int macroLength(sf::Vector2i box, Direction direction) const;
+
+    // Checks if a cell is part of a one-wide tunnel with an exit in the direction
+    bool isTunnel(sf::Vector2i cell, Direction direction) const;
+
+    // Checks if removing a cell splits the floor into separate areas
+    bool isArticulationPoint(sf::Vector2i cell) const;
+
+    // Checks if a cell belongs to a goal room with a single entrance
+    bool isGoalRoom(sf::Vector2i cell) const;
+
     // Checks if the game is won
     bool isWon() const;
 
@@ -63,7 +84,27 @@ class Sokoban : public sf::Drawable {
     sf::SoundBuffer winSoundBuffer;
     sf::Sound winSound;
     Direction latestMove = Direction::Down;
-    bool isOutOfBounds(int x, int y);
+    std::vector<std::vector<bool>> tunnelCells;  // One board per Direction
+    std::vector<bool> articulationPoints;
+    std::vector<int> goalRooms;  // Room id per cell, -1 if not in a goal room
+    std::vector<int> roomEntrances;  // Entrance cell per room id
+    std::vector<std::vector<int>> roomSlots;  // Storage cells per room id, fill order
+    static sf::Vector2i directionDelta(Direction direction);
+    bool isOutOfBounds(int x, int y) const;
+    bool isFloor(int x, int y) const;
+    bool isOneWide(int x, int y, Direction direction) const;
+    Tile floorTile(int index) const;
+    void analyzeLevel();
+    void findArticulationPoints(int start, int& time,
+        std::vector<int>& discovery, std::vector<int>& low);
+    int planMacro(const std::vector<Tile>& start, sf::Vector2i player, Direction direction,
+        std::vector<Direction>& moves) const;
+    bool planRoomPushes(std::vector<Tile>& board, sf::Vector2i& player, sf::Vector2i& box,
+        int room, std::vector<Direction>& moves, int& pushes) const;
+    void findReachable(const std::vector<Tile>& board, sf::Vector2i from,
+        std::vector<int>& step, std::vector<int>& queue) const;
+    bool findPlayerPath(const std::vector<Tile>& board, sf::Vector2i from, sf::Vector2i to,
+        std::vector<Direction>& moves) const;
 };
 
 }  // namespace SB
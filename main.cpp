@@ -43,6 +43,15 @@ int main(int argc, char* argv[]) {
                 if (event.key.code == sf::Keyboard::R) {
                     game.restart();
                     clock.restart();
+                } else if (event.key.shift && event.key.code == sf::Keyboard::Right) {
+                    // Shift + arrow pushes a box through a tunnel or into its goal room
+                    game.pushThrough(SB::Direction::Right);
+                } else if (event.key.shift && event.key.code == sf::Keyboard::Left) {
+                    game.pushThrough(SB::Direction::Left);
+                } else if (event.key.shift && event.key.code == sf::Keyboard::Up) {
+                    game.pushThrough(SB::Direction::Up);
+                } else if (event.key.shift && event.key.code == sf::Keyboard::Down) {
+                    game.pushThrough(SB::Direction::Down);
                 } else if (event.key.code == sf::Keyboard::Right) {
                     game.movePlayer(SB::Direction::Right);
                 } else if (event.key.code == sf::Keyboard::Left) {
@@ -221,4 +221,109 @@ BOOST_AUTO_TEST_CASE(manyStorages) {
     BOOST_CHECK(sb.isWon());
 }
 
+// Push a box through a one-wide tunnel in a single macro move
+BOOST_AUTO_TEST_CASE(tunnelPush) {
+    Sokoban sb;
+    std::ifstream levelFile("assets/tunnel.lvl");
+    levelFile >> sb;
+
+    BOOST_CHECK(sb.isTunnel(sf::Vector2i(4, 1), Direction::Right));
+    BOOST_CHECK(!sb.isTunnel(sf::Vector2i(4, 1), Direction::Up));
+
+    // Box stops on the storage at the end of the tunnel.
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Right), 5);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 6);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 1);
+    BOOST_CHECK(sb.isWon());
+
+    // Nothing to push once the box is gone.
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Left), 0);
+}
+
+// Push a box through the entrance of a goal room into its storage slot
+BOOST_AUTO_TEST_CASE(goalRoomPush) {
+    Sokoban sb;
+    std::ifstream levelFile("assets/goalroom.lvl");
+    levelFile >> sb;
+
+    BOOST_CHECK(sb.isArticulationPoint(sf::Vector2i(3, 3)));
+    BOOST_CHECK(!sb.isArticulationPoint(sf::Vector2i(1, 1)));
+    BOOST_CHECK(sb.isGoalRoom(sf::Vector2i(3, 5)));
+    BOOST_CHECK(!sb.isGoalRoom(sf::Vector2i(1, 1)));
+
+    // Previewing the macro leaves the game untouched.
+    BOOST_CHECK_EQUAL(sb.macroLength(sf::Vector2i(3, 2), Direction::Down), 3);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 1);
+    BOOST_CHECK(!sb.isWon());
+
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Down), 3);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 3);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 4);
+    BOOST_CHECK(sb.isWon());
+}
+
+// Goal-room slot that is not straight ahead of the entrance
+BOOST_AUTO_TEST_CASE(goalRoomTurn) {
+    Sokoban sb;
+    std::ifstream levelFile("assets/goalroom2.lvl");
+    levelFile >> sb;
+
+    // Down through the entrance, walk round the box, then left twice.
+    BOOST_CHECK_EQUAL(sb.macroMoves(sf::Vector2i(3, 2), Direction::Down).size(), 7u);
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Down), 5);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 2);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 5);
+    BOOST_CHECK(sb.isWon());
+}
+
+// Box leaving a tunnel stops on the first cell of the open room
+BOOST_AUTO_TEST_CASE(tunnelExit) {
+    Sokoban sb;
+    std::ifstream levelFile("assets/tunnelexit.lvl");
+    levelFile >> sb;
+
+    BOOST_CHECK(!sb.isGoalRoom(sf::Vector2i(6, 2)));
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Right), 3);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 4);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 2);
+    BOOST_CHECK(!sb.isWon());
+}
+
+// Tunnel opening onto a dead corner is not a tunnel
+BOOST_AUTO_TEST_CASE(tunnelCorner) {
+    Sokoban sb;
+    std::ifstream levelFile("assets/tunnelcorner.lvl");
+    levelFile >> sb;
+
+    BOOST_CHECK(!sb.isTunnel(sf::Vector2i(3, 0), Direction::Right));
+    BOOST_CHECK(!sb.isTunnel(sf::Vector2i(2, 0), Direction::Right));
+
+    // Only the single push, the box is not left stuck in the corner.
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Right), 1);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 2);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 0);
+}
+
+// Dead-end shaft is not a tunnel and the main room is not a goal room
+BOOST_AUTO_TEST_CASE(deadEndTunnel) {
+    Sokoban sb;
+    std::ifstream levelFile("assets/deadend.lvl");
+    levelFile >> sb;
+
+    BOOST_CHECK(!sb.isTunnel(sf::Vector2i(2, 5), Direction::Down));
+    BOOST_CHECK(sb.isTunnel(sf::Vector2i(2, 5), Direction::Up));
+    BOOST_CHECK(sb.isArticulationPoint(sf::Vector2i(2, 4)));
+    BOOST_CHECK(!sb.isGoalRoom(sf::Vector2i(1, 3)));
+
+    // Only the single push the player asked for.
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Down), 1);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 2);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 3);
+
+    // With no box ahead it is an ordinary step.
+    BOOST_CHECK_EQUAL(sb.pushThrough(Direction::Left), 0);
+    BOOST_CHECK_EQUAL(sb.playerLoc().x, 1);
+    BOOST_CHECK_EQUAL(sb.playerLoc().y, 3);
+}
+
 }  // namespace SB